@@ -1,6 +1,7 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include <QDebug>
+#include <QScrollBar>
 #include <QSslSocket>
 #include <QString>
 
@@ -14,6 +15,17 @@ MainWindow::MainWindow(QWidget *parent)
     connect(networkManager, &QNetworkAccessManager::finished,
             this, &MainWindow::onNetworkReply);
 
+    // Thumbnails are loaded for visible rows once scrolling settles
+    ui->listWidgetManga->setIconSize(QSize(32, 45));
+    thumbnailTimer = new QTimer(this);
+    thumbnailTimer->setSingleShot(true);
+    thumbnailTimer->setInterval(100);
+
+    connect(thumbnailTimer, &QTimer::timeout,
+            this, &MainWindow::loadVisibleThumbnails);
+    connect(ui->listWidgetManga->verticalScrollBar(), &QScrollBar::valueChanged,
+            this, &MainWindow::onMangaListScrolled);
+
     qDebug() << QSqlDatabase::drivers();
     if (initDatabase()) {
         loadBookmarksFromDb();
@@ -138,11 +150,38 @@ void MainWindow::on_pushButtonSearch_clicked()
         return;
     }
 
-    // URL encode the search text to handle special characters and spaces
-    QString encodedText = QUrl::toPercentEncoding(searchText);
+    // Start a new paged search, replies from older searches are ignored
+    searchTitle = searchText;
+    searchOffset = 0;
+    searchTotal = -1;
+    searchLoading = false;
+    ++searchGeneration;
+
+    thumbnailRequested.clear();
+    ui->listWidgetManga->clear();
+
+    fetchSearchPage();
+}
 
-    // Construct the URL with the search parameter
-    QUrl url(QString("https://api.mangadex.org/manga?title=%1").arg(encodedText));
+void MainWindow::fetchSearchPage()
+{
+    if (searchLoading || searchTitle.isEmpty()) return;
+    if (searchTotal >= 0 && searchOffset >= searchTotal) return;
+
+    // Construct the URL with the search parameters, cover art is included
+    // so every row gets its thumbnail filename in the same round trip
+    QUrl url("https://api.mangadex.org/manga");
+    QUrlQuery query;
+    // Encoded up front, QUrlQuery leaves '+' alone and the server would read it as a space
+    query.addQueryItem("title", QUrl::toPercentEncoding(searchTitle));
+    int limit = searchPageSize;
+    if (searchTotal >= 0) {
+        limit = qMin(limit, searchTotal - searchOffset);
+    }
+    query.addQueryItem("limit", QString::number(limit));
+    query.addQueryItem("offset", QString::number(searchOffset));
+    query.addQueryItem("includes[]", "cover_art");
+    url.setQuery(query.query(QUrl::FullyEncoded), QUrl::StrictMode);
 
     QNetworkRequest request(url);
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
@@ -153,13 +192,66 @@ void MainWindow::on_pushButtonSearch_clicked()
     QNetworkReply *reply = networkManager->get(request);
 
     reply->setProperty("requestType", MangaSearch);
+    reply->setProperty("searchGeneration", searchGeneration);
+
+    searchLoading = true;
+}
+
+void MainWindow::onMangaListScrolled(int value)
+{
+    // Fetch the next page when close to the bottom
+    QScrollBar *scrollBar = ui->listWidgetManga->verticalScrollBar();
+    if (value >= scrollBar->maximum() - scrollBar->pageStep() / 2) {
+        fetchSearchPage();
+    }
+
+    thumbnailTimer->start();
+}
+
+void MainWindow::loadVisibleThumbnails()
+{
+    QListWidget *list = ui->listWidgetManga;
+    if (list->count() == 0) return;
+
+    // Keep fetching until the list can scroll, otherwise no further page is requested
+    if (list->verticalScrollBar()->maximum() == 0) {
+        fetchSearchPage();
+    }
+
+    QRect viewport = list->viewport()->rect();
+    QListWidgetItem *firstItem = list->itemAt(viewport.topLeft());
+    QListWidgetItem *lastItem = list->itemAt(viewport.bottomLeft());
+
+    int first = firstItem ? list->row(firstItem) : 0;
+    int last = lastItem ? list->row(lastItem) : list->count() - 1;
+
+    for (int row = first; row <= last; ++row) {
+        QString coverUrl = list->item(row)->data(Qt::UserRole + 3).toString();
+        if (coverUrl.isEmpty() || thumbnailRequested.contains(row)) continue;
+
+        thumbnailRequested.insert(row);
+
+        // MangaDex serves a 256px wide variant next to every cover
+        QNetworkRequest request{QUrl(coverUrl + ".256.jpg")};
+        QNetworkReply *reply = networkManager->get(request);
+        reply->setProperty("requestType", Thumbnail);
+        reply->setProperty("searchGeneration", searchGeneration);
+        reply->setProperty("row", row);
+    }
 }
 
 void MainWindow::populateMangaList(const QJsonObject& jsonObj)
 {
-    ui->listWidgetManga->clear();
+    // Rows are appended, the list is cleared when a new search starts
     QJsonArray dataArray = jsonObj["data"].toArray();
 
+    searchLoading = false;
+    searchOffset += dataArray.size();
+    searchTotal = qMin(jsonObj["total"].toInt(), searchResultCap);
+    if (dataArray.isEmpty()) {
+        searchTotal = searchOffset;
+    }
+
     for (const QJsonValue& value : dataArray) {
         QJsonObject manga = value.toObject();
         QJsonObject attributes = manga["attributes"].toObject();
@@ -189,6 +281,20 @@ void MainWindow::populateMangaList(const QJsonObject& jsonObj)
         QString year = QString::number(attributes["year"].toInt());
         QString status = attributes["status"].toString();
 
+        // Cover filename comes from the included cover_art relationship
+        QString coverUrl;
+        for (const QJsonValue &rel : manga["relationships"].toArray()) {
+            QJsonObject relObj = rel.toObject();
+            if (relObj["type"].toString() == "cover_art") {
+                QString filename = relObj["attributes"].toObject()["fileName"].toString();
+                if (!filename.isEmpty()) {
+                    coverUrl = QString("https://uploads.mangadex.org/covers/%1/%2")
+                                   .arg(mangaId, filename);
+                }
+                break;
+            }
+        }
+
         // Create list item with title
         QListWidgetItem *item = new QListWidgetItem(title);
 
@@ -196,6 +302,7 @@ void MainWindow::populateMangaList(const QJsonObject& jsonObj)
         item->setData(Qt::UserRole, mangaId);
         item->setData(Qt::UserRole + 1, year);
         item->setData(Qt::UserRole + 2, status);
+        item->setData(Qt::UserRole + 3, coverUrl);
 
         // Optional: Add tooltip
         item->setToolTip(QString("Year: %1\nStatus: %2\nID: %3")
@@ -203,11 +310,21 @@ void MainWindow::populateMangaList(const QJsonObject& jsonObj)
 
         ui->listWidgetManga->addItem(item);
     }
+
+    // Runs after the list has been laid out with the new rows
+    thumbnailTimer->start();
 }
 
-void MainWindow::populateChapterList(const QJsonObject& jsonObj)
+void MainWindow::populateChapterList(const QJsonObject& jsonObj,
+                                     const QString &mangaId,
+                                     const QString &mangaTitle)
 {
     ui->listWidgetChapter->clear();
+
+    // selected changes on press, the list only once the feed arrives
+    chapterListMangaId = mangaId;
+    chapterListTitle = mangaTitle;
+
     qDebug() << "\n========== CHAPTER LIST ==========";
 
     QJsonArray dataArray = jsonObj["data"].toArray();
@@ -299,6 +416,27 @@ void MainWindow::onNetworkReply(QNetworkReply *reply)
 {
     // Check for network errors
     if (reply->error() != QNetworkReply::NoError) {
+        int failedType = reply->property("requestType").toInt();
+
+        // A missing thumbnail is not worth a dialog
+        if (failedType == Thumbnail) {
+            qDebug() << "Failed to load thumbnail:" << reply->errorString();
+            reply->deleteLater();
+            return;
+        }
+
+        if (failedType == MangaSearch) {
+            // Results of a previous search are dropped, so are its errors
+            if (reply->property("searchGeneration").toInt() != searchGeneration) {
+                qDebug() << "Ignoring error of a previous search:" << reply->errorString();
+                reply->deleteLater();
+                return;
+            }
+            // Stop paging so scrolling doesn't retry into the same error
+            searchLoading = false;
+            searchTotal = searchOffset;
+        }
+
         QMessageBox::critical(this, "Network Error",
                               QString("Error: %1").arg(reply->errorString()));
         reply->deleteLater();
@@ -349,10 +487,35 @@ void MainWindow::onNetworkReply(QNetworkReply *reply)
         return;
     }
 
+    // Handle search row thumbnails
+    if (requestType == Thumbnail) {
+        int row = reply->property("row").toInt();
+        QListWidgetItem *item = ui->listWidgetManga->item(row);
+
+        QPixmap pixmap;
+        if (reply->property("searchGeneration").toInt() == searchGeneration && item
+            && pixmap.loadFromData(responseData)) {
+            item->setIcon(QIcon(pixmap.scaled(ui->listWidgetManga->iconSize(),
+                                              Qt::KeepAspectRatio,
+                                              Qt::SmoothTransformation)));
+        }
+
+        reply->deleteLater();
+        return;
+    }
+
     // Parse JSON
     QJsonParseError parseError;
     QJsonDocument doc = QJsonDocument::fromJson(responseData, &parseError);
 
+    // An unusable search page ends paging, the error below is shown once
+    if (requestType == MangaSearch
+        && reply->property("searchGeneration").toInt() == searchGeneration
+        && (parseError.error != QJsonParseError::NoError || !doc.isObject())) {
+        searchLoading = false;
+        searchTotal = searchOffset;
+    }
+
     if (parseError.error != QJsonParseError::NoError) {
         QMessageBox::critical(this, "JSON Parse Error",
                               QString("Parse error at %1: %2")
@@ -374,12 +537,18 @@ void MainWindow::onNetworkReply(QNetworkReply *reply)
 
         switch (requestType) {
         case MangaSearch:
+            if (reply->property("searchGeneration").toInt() != searchGeneration) {
+                qDebug() << "Ignoring results of a previous search";
+                break;
+            }
             qDebug() << "Received manga search results";
             populateMangaList(obj);
             break;
         case ChapterFeed:
             qDebug() << "Received chapter feed";
-            populateChapterList(obj);
+            populateChapterList(obj,
+                                reply->property("mangaId").toString(),
+                                reply->property("mangaTitle").toString());
             break;
         case MangaDetails: {
             qDebug() << "Received manga details for cover";
@@ -450,7 +619,15 @@ void MainWindow::on_listWidgetManga_itemPressed(QListWidgetItem *item)
     selected.mangaId = mangaId;
     selected.chapter = -1;
 
-    fetchMangaCover(mangaId);
+    // The search already returned the cover filename, skip the lookup chain
+    QString coverUrl = item->data(Qt::UserRole + 3).toString();
+    if (!coverUrl.isEmpty()) {
+        QNetworkRequest imageRequest{QUrl(coverUrl)};
+        QNetworkReply *imageReply = networkManager->get(imageRequest);
+        imageReply->setProperty("requestType", 999); // Special marker for actual image
+    } else {
+        fetchMangaCover(mangaId);
+    }
 }
 
 void MainWindow::on_listWidgetChapter_itemPressed(QListWidgetItem *item)
@@ -596,3 +773,78 @@ void MainWindow::displayCoverImage(const QByteArray &imageData)
         ui->labelCover->setText("Failed to load cover");
     }
 }
+
+void MainWindow::on_pushButtonRead_clicked()
+{
+    QListWidgetItem *item = ui->listWidgetChapter->currentItem();
+    if (!item) {
+        QMessageBox::warning(this, "No Selection", "Please select a chapter to read.");
+        return;
+    }
+
+    openReader(item);
+}
+
+void MainWindow::on_listWidgetChapter_itemDoubleClicked(QListWidgetItem *item)
+{
+    if (!item) return;
+
+    openReader(item);
+}
+
+void MainWindow::openReader(QListWidgetItem *chapterItem)
+{
+    // Build the reading order from the chapter list, one entry per chapter number
+    // (the feed can hold several scanlations of the same chapter)
+    QList<ReaderWindow::ChapterRef> chapters;
+    int startIndex = 0;
+
+    for (int i = 0; i < ui->listWidgetChapter->count(); ++i) {
+        QListWidgetItem *item = ui->listWidgetChapter->item(i);
+
+        ReaderWindow::ChapterRef chapter;
+        chapter.id = item->data(Qt::UserRole).toString();
+        chapter.number = item->data(Qt::UserRole + 1).toString();
+
+        bool duplicate = !chapters.isEmpty() && !chapter.number.isEmpty()
+                         && chapters.last().number == chapter.number;
+
+        if (duplicate) {
+            // Keep the scanlation the user picked
+            if (item == chapterItem) {
+                chapters.last() = chapter;
+            }
+        } else {
+            chapters.append(chapter);
+        }
+
+        if (item == chapterItem) {
+            startIndex = chapters.size() - 1;
+        }
+    }
+
+    ReaderWindow *reader = new ReaderWindow(chapterListMangaId, chapterListTitle,
+                                            chapters, startIndex, this);
+
+    connect(reader, &ReaderWindow::chapterFinished,
+            this, &MainWindow::onReaderChapterFinished);
+
+    reader->show();
+}
+
+void MainWindow::onReaderChapterFinished(const QString &mangaId, const QString &title, double chapter)
+{
+    qDebug() << "Finished reading" << title << "chapter" << chapter;
+
+    // Only advance bookmarks that exist, and never move them backwards
+    if (!bookmarks.contains(mangaId)) return;
+
+    Bookmark current = bookmarks[mangaId];
+    if (chapter <= current.chapter) return;
+
+    current.chapter = chapter;
+    if (saveBookmarkToDb(current)) {
+        qDebug() << "Advanced bookmark:" << current.title << "chapter" << current.chapter;
+        loadBookmarksFromDb();
+    }
+}
@@ -11,12 +11,14 @@
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QNetworkRequest>
+#include <QSet>
 #include <QSqlDatabase>
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QTimer>    // for QTimer
 #include <QUrlQuery> // for QUrlQuery
 #include <qjsonarray.h>
+#include "readerwindow.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -62,12 +64,28 @@ private slots:
 
     void on_pushButtonDelete_clicked();
 
+    void on_pushButtonRead_clicked();
+
+    void on_listWidgetChapter_itemDoubleClicked(QListWidgetItem *item);
+
+    void onReaderChapterFinished(const QString &mangaId, const QString &title, double chapter);
+
+    void onMangaListScrolled(int value);
+
+    void loadVisibleThumbnails();
+
 private:
     Ui::MainWindow *ui;
     QNetworkAccessManager *networkManager;
 
     void populateMangaList(const QJsonObject& jsonObj);
-    void populateChapterList(const QJsonObject& jsonObj);
+    void populateChapterList(const QJsonObject& jsonObj,
+                             const QString &mangaId,
+                             const QString &mangaTitle);
+
+    // Manga the entries of listWidgetChapter belong to
+    QString chapterListMangaId;
+    QString chapterListTitle;
 
     QLabel *coverLabel;
 
@@ -75,7 +93,22 @@ private:
     void fetchCoverImage(const QString &mangaId, const QString &coverId);
     void displayCoverImage(const QByteArray &imageData);
 
-    enum RequestType { MangaSearch, ChapterFeed, MangaDetails, CoverImage };
+    enum RequestType { MangaSearch, ChapterFeed, MangaDetails, CoverImage, Thumbnail };
+
+    // Paged search state, pages are fetched as the manga list scrolls
+    static constexpr int searchPageSize = 20;
+    // The API rejects pages where offset + limit goes past this
+    static constexpr int searchResultCap = 10000;
+    QString searchTitle;
+    int searchOffset = 0;
+    int searchTotal = -1;
+    int searchGeneration = 0;
+    bool searchLoading = false;
+
+    QSet<int> thumbnailRequested; // rows of the current search
+    QTimer *thumbnailTimer;
+
+    void fetchSearchPage();
 
     bool loadingFromBookmark = false;
 
@@ -85,5 +118,7 @@ private:
     bool saveBookmarkToDb(const Bookmark &bookmark);
     bool loadBookmarksFromDb();
     bool deleteBookmarkFromDb(const QString &mangaId);
+
+    void openReader(QListWidgetItem *chapterItem);
 };
 #endif
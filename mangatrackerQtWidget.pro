@@ -1,4 +1,4 @@
-QT       += core gui network sql
+QT       += core gui network sql concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -10,13 +10,16 @@ CONFIG += c++17
 
 SOURCES += \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    readerwindow.cpp
 
 HEADERS += \
-    mainwindow.h
+    mainwindow.h \
+    readerwindow.h
 
 FORMS += \
-    mainwindow.ui
+    mainwindow.ui \
+    readerwindow.ui
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
@@ -0,0 +1,389 @@
+#include "readerwindow.h"
+#include "ui_readerwindow.h"
+#include <QDebug>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QScrollBar>
+#include <QtConcurrent>
+
+ReaderWindow::ReaderWindow(const QString &mangaId,
+                           const QString &mangaTitle,
+                           const QList<ChapterRef> &chapters,
+                           int startIndex,
+                           QWidget *parent)
+    : QWidget(parent)
+    , ui(new Ui::ReaderWindow)
+    , mangaId(mangaId)
+    , mangaTitle(mangaTitle)
+    , chapters(chapters)
+{
+    ui->setupUi(this);
+    setWindowFlag(Qt::Window);
+    setAttribute(Qt::WA_DeleteOnClose);
+
+    networkManager = new QNetworkAccessManager(this);
+
+    connect(networkManager, &QNetworkAccessManager::finished,
+            this, &ReaderWindow::onNetworkReply);
+
+    // Roughly 256 MB of decoded pages
+    pageCache.setMaxCost(256 * 1024);
+
+    openChapter(startIndex);
+}
+
+ReaderWindow::~ReaderWindow()
+{
+    delete ui;
+}
+
+void ReaderWindow::openChapter(int index, int page)
+{
+    if (index < 0 || index >= chapters.size()) return;
+
+    chapterIndex = index;
+    pageIndex = 0;
+    finishedReported = false;
+    downloadQueue.clear();
+
+    const ChapterRef &chapter = chapters[chapterIndex];
+    setWindowTitle(QString("%1 - Ch. %2").arg(mangaTitle, chapter.number));
+
+    showPage(page);
+}
+
+void ReaderWindow::resolveChapter(const QString &chapterId)
+{
+    if (resolving.contains(chapterId)) return;
+    resolving.insert(chapterId);
+
+    QString url = QString("https://api.mangadex.org/at-home/server/%1").arg(chapterId);
+
+    QNetworkRequest request{QUrl(url)};
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+
+    QNetworkReply *reply = networkManager->get(request);
+    reply->setProperty("requestType", AtHomeServer);
+    reply->setProperty("chapterId", chapterId);
+
+    qDebug() << "Resolving at-home server from:" << url;
+}
+
+bool ReaderWindow::ensureResolved(const QString &chapterId)
+{
+    if (resolved.contains(chapterId)) {
+        if (resolved[chapterId].age.elapsed() < atHomeMaxAgeMs) return true;
+
+        qDebug() << "At-home server for chapter" << chapterId << "expired";
+        resolved.remove(chapterId);
+    }
+
+    resolveChapter(chapterId);
+    return false;
+}
+
+QString ReaderWindow::pageKey(const QString &url)
+{
+    // "data/<hash>/<file>", stays the same when the chapter moves to another node
+    return url.section('/', -3);
+}
+
+QStringList ReaderWindow::pageUrls(const QString &chapterId) const
+{
+    QStringList urls;
+    if (!resolved.contains(chapterId)) return urls;
+
+    const ChapterPages pages = resolved.value(chapterId);
+    const QStringList &files = dataSaver ? pages.dataSaver : pages.data;
+    const QString folder = dataSaver ? "data-saver" : "data";
+
+    for (const QString &file : files) {
+        urls << QString("%1/%2/%3/%4").arg(pages.baseUrl, folder, pages.hash, file);
+    }
+    return urls;
+}
+
+void ReaderWindow::showPage(int index)
+{
+    const QString chapterId = chapters[chapterIndex].id;
+
+    // Shown again once the at-home reply arrives
+    if (!ensureResolved(chapterId)) {
+        pageIndex = qMax(0, index);
+        waitingKey.clear();
+        ui->labelPage->setText("Loading chapter...");
+        ui->labelInfo->setText("-");
+        return;
+    }
+
+    QStringList urls = pageUrls(chapterId);
+    if (urls.isEmpty()) {
+        waitingKey.clear();
+        ui->labelPage->setText("No pages available");
+        ui->labelInfo->setText("-");
+        return;
+    }
+
+    pageIndex = qBound(0, index, int(urls.size()) - 1);
+    pageTimer.start();
+
+    // Only the window around the current page stays queued
+    downloadQueue.clear();
+
+    QString url = urls[pageIndex];
+    ui->labelInfo->setText(QString("Page %1 / %2").arg(pageIndex + 1).arg(urls.size()));
+
+    if (QPixmap *cached = pageCache.object(pageKey(url))) {
+        waitingKey.clear();
+        displayPage(*cached);
+    } else {
+        waitingKey = pageKey(url);
+        ui->labelPage->setText("Loading page...");
+        enqueuePage(url, chapterId, true);
+    }
+
+    schedulePrefetch();
+    pumpQueue();
+}
+
+void ReaderWindow::displayPage(const QPixmap &pixmap)
+{
+    ui->labelPage->setPixmap(pixmap);
+    ui->scrollArea->verticalScrollBar()->setValue(0);
+
+    int pageCount = int(pageUrls(chapters[chapterIndex].id).size());
+    qint64 latency = pageTimer.elapsed();
+
+    qDebug() << "Page" << pageIndex + 1 << "displayed in" << latency << "ms";
+    ui->labelInfo->setText(QString("Page %1 / %2 (%3 ms)")
+                               .arg(pageIndex + 1)
+                               .arg(pageCount)
+                               .arg(latency));
+
+    // Reaching the last page counts as finishing the chapter
+    if (pageIndex == pageCount - 1 && !finishedReported) {
+        finishedReported = true;
+
+        bool ok;
+        double chapterNum = chapters[chapterIndex].number.toDouble(&ok);
+        if (ok) {
+            emit chapterFinished(mangaId, mangaTitle, chapterNum);
+        }
+    }
+}
+
+void ReaderWindow::schedulePrefetch()
+{
+    const QString chapterId = chapters[chapterIndex].id;
+    QStringList urls = pageUrls(chapterId);
+
+    int last = qMin(pageIndex + lookahead, int(urls.size()) - 1);
+    for (int i = pageIndex + 1; i <= last; ++i) {
+        enqueuePage(urls[i], chapterId, false);
+    }
+
+    // Close to the end: warm up the first pages of the next chapter
+    if (pageIndex + lookahead >= urls.size() - 1 && chapterIndex + 1 < chapters.size()) {
+        QString nextId = chapters[chapterIndex + 1].id;
+
+        if (ensureResolved(nextId)) {
+            QStringList nextUrls = pageUrls(nextId);
+            for (int i = 0; i < qMin(nextChapterPrefetch, int(nextUrls.size())); ++i) {
+                enqueuePage(nextUrls[i], nextId, false);
+            }
+        }
+    }
+}
+
+void ReaderWindow::enqueuePage(const QString &url, const QString &chapterId, bool urgent)
+{
+    const QString key = pageKey(url);
+    if (pageCache.contains(key) || inFlight.contains(key)) return;
+
+    downloadQueue.removeIf([&key](const QueuedPage &page) { return pageKey(page.url) == key; });
+    if (urgent) {
+        downloadQueue.prepend({url, chapterId});
+    } else {
+        downloadQueue.append({url, chapterId});
+    }
+}
+
+void ReaderWindow::pumpQueue()
+{
+    while (inFlight.size() < maxInFlight && !downloadQueue.isEmpty()) {
+        QueuedPage page = downloadQueue.takeFirst();
+        const QString key = pageKey(page.url);
+        if (pageCache.contains(key) || inFlight.contains(key)) continue;
+
+        // Expired urls are dropped, the pages are queued again once resolved
+        if (!ensureResolved(page.chapterId)) continue;
+
+        QNetworkRequest request{QUrl(page.url)};
+        QNetworkReply *reply = networkManager->get(request);
+        reply->setProperty("requestType", PageImage);
+        reply->setProperty("url", page.url);
+        reply->setProperty("chapterId", page.chapterId);
+
+        inFlight.insert(key);
+    }
+}
+
+void ReaderWindow::decodePage(const QString &url, const QByteArray &data)
+{
+    // Decode and scale off the GUI thread, pages are large
+    int targetWidth = ui->scrollArea->viewport()->width();
+
+    QFutureWatcher<QImage> *watcher = new QFutureWatcher<QImage>(this);
+
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, url]() {
+        QImage image = watcher->result();
+        watcher->deleteLater();
+        inFlight.remove(pageKey(url));
+
+        if (image.isNull()) {
+            qDebug() << "Failed to decode page:" << url;
+            if (pageKey(url) == waitingKey) {
+                ui->labelPage->setText("Failed to load page");
+            }
+        } else {
+            QPixmap pixmap = QPixmap::fromImage(image);
+            pageCache.insert(pageKey(url), new QPixmap(pixmap), int(image.sizeInBytes() / 1024));
+
+            if (pageKey(url) == waitingKey) {
+                waitingKey.clear();
+                displayPage(pixmap);
+            }
+        }
+
+        pumpQueue();
+    });
+
+    watcher->setFuture(QtConcurrent::run([data, targetWidth]() {
+        QImage image;
+        if (!image.loadFromData(data)) return QImage();
+
+        if (targetWidth > 0 && image.width() > targetWidth) {
+            image = image.scaledToWidth(targetWidth, Qt::SmoothTransformation);
+        }
+        return image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }));
+}
+
+void ReaderWindow::onNetworkReply(QNetworkReply *reply)
+{
+    RequestType requestType = static_cast<RequestType>(reply->property("requestType").toInt());
+
+    if (reply->error() != QNetworkReply::NoError) {
+        qDebug() << "Reader network error:" << reply->errorString();
+
+        if (requestType == AtHomeServer) {
+            QString chapterId = reply->property("chapterId").toString();
+            resolving.remove(chapterId);
+            if (chapterId == chapters[chapterIndex].id) {
+                ui->labelPage->setText("Failed to load chapter: " + reply->errorString());
+            }
+        } else {
+            QString url = reply->property("url").toString();
+            QString chapterId = reply->property("chapterId").toString();
+            inFlight.remove(pageKey(url));
+
+            // The node may have gone bad, ask for a new one once
+            if (!retried.contains(chapterId)) {
+                retried.insert(chapterId);
+                resolved.remove(chapterId);
+                downloadQueue.removeIf([&chapterId](const QueuedPage &page) {
+                    return page.chapterId == chapterId;
+                });
+                resolveChapter(chapterId);
+            } else if (pageKey(url) == waitingKey) {
+                ui->labelPage->setText("Failed to load page: " + reply->errorString());
+            }
+            pumpQueue();
+        }
+
+        reply->deleteLater();
+        return;
+    }
+
+    QByteArray responseData = reply->readAll();
+
+    switch (requestType) {
+    case AtHomeServer: {
+        QString chapterId = reply->property("chapterId").toString();
+        resolving.remove(chapterId);
+
+        QJsonObject obj = QJsonDocument::fromJson(responseData).object();
+        QJsonObject chapter = obj["chapter"].toObject();
+
+        ChapterPages pages;
+        pages.baseUrl = obj["baseUrl"].toString();
+        pages.hash = chapter["hash"].toString();
+        pages.age.start();
+        for (const QJsonValue &file : chapter["data"].toArray()) {
+            pages.data << file.toString();
+        }
+        for (const QJsonValue &file : chapter["dataSaver"].toArray()) {
+            pages.dataSaver << file.toString();
+        }
+        resolved.insert(chapterId, pages);
+
+        qDebug() << "Resolved chapter" << chapterId << "on" << pages.baseUrl
+                 << "with" << pages.data.size() << "pages";
+
+        if (chapterId == chapters[chapterIndex].id) {
+            showPage(pageIndex);
+        } else {
+            schedulePrefetch();
+            pumpQueue();
+        }
+        break;
+    }
+    case PageImage:
+        retried.remove(reply->property("chapterId").toString());
+        decodePage(reply->property("url").toString(), responseData);
+        break;
+    }
+
+    reply->deleteLater();
+}
+
+void ReaderWindow::on_pushButtonPrev_clicked()
+{
+    // Chapter dropped after a failure, try resolving it again
+    if (!resolved.contains(chapters[chapterIndex].id)) {
+        showPage(pageIndex);
+        return;
+    }
+
+    if (pageIndex > 0) {
+        showPage(pageIndex - 1);
+    } else if (chapterIndex > 0) {
+        // Going back continues from the end of the previous chapter
+        openChapter(chapterIndex - 1, lastPage);
+    }
+}
+
+void ReaderWindow::on_pushButtonNext_clicked()
+{
+    if (!resolved.contains(chapters[chapterIndex].id)) {
+        showPage(pageIndex);
+        return;
+    }
+
+    if (pageIndex + 1 < pageUrls(chapters[chapterIndex].id).size()) {
+        showPage(pageIndex + 1);
+    } else if (chapterIndex + 1 < chapters.size()) {
+        openChapter(chapterIndex + 1);
+    } else {
+        ui->labelInfo->setText("No more chapters");
+    }
+}
+
+void ReaderWindow::on_checkBoxDataSaver_toggled(bool checked)
+{
+    dataSaver = checked;
+
+    // Page urls change with the image set, requeue from the current page
+    downloadQueue.clear();
+    showPage(pageIndex);
+}
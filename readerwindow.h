@@ -0,0 +1,114 @@
+#ifndef READERWINDOW_H
+#define READERWINDOW_H
+
+#include <QCache>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QPixmap>
+#include <QSet>
+#include <QWidget>
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+namespace Ui {
+class ReaderWindow;
+}
+QT_END_NAMESPACE
+
+class ReaderWindow : public QWidget
+{
+    Q_OBJECT
+
+public:
+    struct ChapterRef {
+        QString id;
+        QString number;
+    };
+
+    ReaderWindow(const QString &mangaId,
+                 const QString &mangaTitle,
+                 const QList<ChapterRef> &chapters,
+                 int startIndex,
+                 QWidget *parent = nullptr);
+    ~ReaderWindow();
+
+signals:
+    // Emitted once per chapter when its last page has been displayed
+    void chapterFinished(const QString &mangaId, const QString &mangaTitle, double chapter);
+
+private slots:
+    void onNetworkReply(QNetworkReply *reply);
+
+    void on_pushButtonPrev_clicked();
+
+    void on_pushButtonNext_clicked();
+
+    void on_checkBoxDataSaver_toggled(bool checked);
+
+private:
+    Ui::ReaderWindow *ui;
+    QNetworkAccessManager *networkManager;
+
+    // At-home server info for a chapter, see /at-home/server/{id}
+    struct ChapterPages {
+        QString baseUrl;
+        QString hash;
+        QStringList data;
+        QStringList dataSaver;
+        QElapsedTimer age;
+    };
+
+    struct QueuedPage {
+        QString url;
+        QString chapterId;
+    };
+
+    enum RequestType { AtHomeServer, PageImage };
+
+    // Pages downloading or decoding at once (bounds the pipeline)
+    static constexpr int maxInFlight = 4;
+    // Pages ahead of the current one to keep queued
+    static constexpr int lookahead = 6;
+    // First pages of the next chapter fetched near the end of this one
+    static constexpr int nextChapterPrefetch = 3;
+    // At-home base urls are short lived, resolve again after this long
+    static constexpr int atHomeMaxAgeMs = 10 * 60 * 1000;
+    // Page index meaning "the last page", showPage clamps it once resolved
+    static constexpr int lastPage = std::numeric_limits<int>::max();
+
+    QString mangaId;
+    QString mangaTitle;
+    QList<ChapterRef> chapters;
+    int chapterIndex = 0;
+    int pageIndex = 0;
+    bool finishedReported = false;
+    bool dataSaver = false;
+
+    QMap<QString, ChapterPages> resolved; // chapterId -> at-home info
+    QSet<QString> resolving;
+    QSet<QString> retried;                // chapters re-resolved after a page failure
+    QCache<QString, QPixmap> pageCache;   // page key -> decoded page, cost in KB
+    QList<QueuedPage> downloadQueue;
+    QSet<QString> inFlight;               // page keys downloading or decoding
+    QString waitingKey;                   // page key the view is waiting for
+    QElapsedTimer pageTimer;
+
+    void openChapter(int index, int page = 0);
+    void resolveChapter(const QString &chapterId);
+    bool ensureResolved(const QString &chapterId);
+    static QString pageKey(const QString &url);
+    QStringList pageUrls(const QString &chapterId) const;
+    void showPage(int index);
+    void displayPage(const QPixmap &pixmap);
+    void schedulePrefetch();
+    void enqueuePage(const QString &url, const QString &chapterId, bool urgent);
+    void pumpQueue();
+    void decodePage(const QString &url, const QByteArray &data);
+};
+#endif